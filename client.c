@@ -52,6 +52,21 @@
 #include	<sys/uio.h>
 #endif
 
+#include    "frame.h"
+
+
+#define SEND_CLIENT_MODE_SEND       0       /* 单向发送, 统计 send 耗时 */
+#define SEND_CLIENT_MODE_WINDOW     1       /* 请求/应答, 允许多个在途消息 */
+#define SEND_CLIENT_MODE_CONNECT    2       /* 建连速率及建连耗时测试 */
+#define SEND_CLIENT_MODE_UDP        3       /* UDP 单播/组播, 统计丢包率及往返延时 */
+
+#define SEND_CLIENT_MAX_LIST        32      /* -w/-r/-B 列表的最大长度 */
+#define SEND_CLIENT_MAX_WINDOW      65536
+#define SEND_CLIENT_MAX_BATCH       1024
+#define SEND_CLIENT_MAX_UDP_SIZE    65507
+#define SEND_CLIENT_UDP_RECV_SIZE   256
+#define SEND_CLIENT_UDP_CTRL_SIZE   CMSG_SPACE(sizeof(uint32_t))
+
 
 typedef int64_t         int64;
 typedef int32_t         int32;
@@ -68,6 +83,21 @@ int16           _cpu = -1;
 int32           _block = 0;
 int32           _tcpnodelay = 0;
 int32           _sndbuf = 0;
+int32           _mode = SEND_CLIENT_MODE_SEND;
+int32           _windows[SEND_CLIENT_MAX_LIST] = {1};
+int32           _windowCount = 1;
+int32           _concurrency = 1;
+int32           _fastopen = 0;
+int32           _rstClose = 0;
+char            *_pOutputFile = NULL;
+int32           _rates[SEND_CLIENT_MAX_LIST] = {0};
+int32           _rateCount = 1;
+int32           _batches[SEND_CLIENT_MAX_LIST] = {1};
+int32           _batchCount = 1;
+char            *_pMcastGroup = NULL;
+char            *_pMcastIf = NULL;
+int32           _rcvbuf = 0;
+int32           _drainMs = 200;
 
 
 static inline int32
@@ -209,19 +239,888 @@ _SendClient_Connect(const char *pIpAddr, uint16 port) {
 }
 
 
+/**
+ * 在途消息环中的一个槽位
+ */
+typedef struct _SendClientSlot {
+    /** 占用该槽位的消息序号, 空闲时为 UINT64_MAX */
+    uint64_t            seq;
+    /** 发送时间 (纳秒) */
+    int64               sendNs;
+} _SendClientSlotT;
+
+
+static int
+_SendClient_CompareInt64(const void *a, const void *b) {
+    int64               x = *(const int64 *) a;
+    int64               y = *(const int64 *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * 对延时样本排序并输出平均值及各分位数 (样本单位为纳秒, 输出单位为微秒)
+ *
+ * @param   pLabel          输出行的前缀
+ * @param   pSamples        延时样本 (会被排序)
+ * @param   count           样本个数
+ */
+static void
+_SendClient_PrintLatency(const char *pLabel, int64 *pSamples, int32 count) {
+    static const double pcts[] = {50, 90, 99, 99.9};
+    int64               total = 0;
+    int32               i = 0;
+    int32               idx = 0;
+
+    if (count <= 0) {
+        fprintf(stdout, "%s no samples\n", pLabel);
+        return;
+    }
+
+    qsort(pSamples, count, sizeof(int64), _SendClient_CompareInt64);
+    for (i = 0; i < count; i++) {
+        total += pSamples[i];
+    }
+
+    fprintf(stdout, "%s avg %.02f", pLabel, (double) total / count / 1000);
+    for (i = 0; i < (int32) (sizeof(pcts) / sizeof(pcts[0])); i++) {
+        idx = (int32) ((pcts[i] / 100) * count + 0.999999) - 1;
+        if (idx < 0) {
+            idx = 0;
+        }
+        fprintf(stdout, ", p%g %.02f", pcts[i], (double) pSamples[idx] / 1000);
+    }
+    fprintf(stdout, ", max %.02f us\n", (double) pSamples[count - 1] / 1000);
+}
+
+
+/**
+ * 将延时样本 (纳秒) 按每行一个写入 _pOutputFile + pSuffix, 供 compare 工具比较
+ *
+ * @param   pSuffix         文件名后缀
+ * @param   pSamples        延时样本
+ * @param   count           样本个数
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_SendClient_DumpSamples(const char *pSuffix, const int64 *pSamples,
+        int32 count) {
+    char                path[1024];
+    FILE                *fp = NULL;
+    int32               i = 0;
+
+    if (_pOutputFile == NULL) {
+        return 0;
+    }
+
+    snprintf(path, sizeof(path), "%s%s", _pOutputFile, pSuffix);
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Open %s failed: %d - %s\n", path, errno, strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        fprintf(fp, "%lld\n", (long long) pSamples[i]);
+    }
+
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "Write %s failed: %d - %s\n", path, errno, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * 以窗口方式发送请求并等待应答
+ *
+ * 客户端最多保持 window 个未应答的消息, 服务端对每个消息回一个应答帧,
+ * 客户端按序号在预分配的环中找到对应的发送时间并计算往返延时.
+ *
+ * @param   socketFd        连接
+ * @param   pMsg            消息缓存 (帧头位于起始位置)
+ * @param   frameSize       帧长度
+ * @param   window          最大在途消息数
+ * @param   pRing           在途消息环 (大小为 ringMask + 1)
+ * @param   ringMask        环的掩码
+ * @param   pSamples        延时样本 (至少 _msgCount 个)
+ * @param   pNextSeq        下一个消息序号 (各轮之间连续)
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_SendClient_RunWindow(int32 socketFd, char *pMsg, int32 frameSize,
+        int32 window, _SendClientSlotT *pRing, int32 ringMask,
+        int64 *pSamples, uint64_t *pNextSeq) {
+    VerifyFrameHeadT    *pHead = (VerifyFrameHeadT *) pMsg;
+    VerifyFrameHeadT    ack;
+    _SendClientSlotT    *pSlot = NULL;
+    char                recvBuff[4096];
+    int32               recvLen = 0;
+    int32               pos = 0;
+    int32               sent = 0;
+    int32               acked = 0;
+    int32               sendOff = -1;
+    int32               ret = 0;
+    uint64_t            seq = 0;
+    int64               nowNs = 0;
+    int64               startNs = VerifyFrame_NowNs();
+    int64               nextSendNs = startNs;
+    int64               elapsedNs = 0;
+    char                label[64];
+
+    while (acked < _msgCount) {
+        /* 窗口未满时开始发送下一个消息 */
+        if (sendOff < 0 && sent < _msgCount && sent - acked < window) {
+            nowNs = VerifyFrame_NowNs();
+            if (nowNs >= nextSendNs) {
+                seq = (*pNextSeq)++;
+                pSlot = &pRing[seq & ringMask];
+                pSlot->seq = seq;
+                pSlot->sendNs = nowNs;
+                VerifyFrame_SetHead(pHead, frameSize, 0, seq, nowNs);
+
+                sendOff = 0;
+                nextSendNs = nowNs + _intervalUs * 1000;
+            }
+        }
+
+        if (sendOff >= 0) {
+            ret = send(socketFd, pMsg + sendOff, frameSize - sendOff,
+                    MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (ret > 0) {
+                sendOff += ret;
+                if (sendOff >= frameSize) {
+                    sendOff = -1;
+                    sent++;
+                }
+            } else if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK
+                    && errno != EINTR) {
+                fprintf(stderr, "Send failed: %d - %s\n", errno, strerror(errno));
+                return -1;
+            }
+        }
+
+        ret = recv(socketFd, recvBuff + recvLen, sizeof(recvBuff) - recvLen,
+                MSG_DONTWAIT);
+        if (ret == 0) {
+            fprintf(stderr, "Server closed the connection\n");
+            return -1;
+        } else if (ret < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                fprintf(stderr, "Recv failed: %d - %s\n", errno, strerror(errno));
+                return -1;
+            }
+            continue;
+        }
+
+        recvLen += ret;
+        nowNs = VerifyFrame_NowNs();
+        for (pos = 0; recvLen - pos >= (int32) sizeof(ack);
+                pos += sizeof(ack)) {
+            memcpy(&ack, recvBuff + pos, sizeof(ack));
+            seq = be64toh(ack.seq);
+            pSlot = &pRing[seq & ringMask];
+
+            if (ntohl(ack.msgLen) != sizeof(ack)
+                    || ! (ntohl(ack.flags) & VERIFY_FRAME_FLAG_ACK)
+                    || pSlot->seq != seq) {
+                fprintf(stderr, "Unexpected ack frame (seq: %llu)\n",
+                        (unsigned long long) seq);
+                return -1;
+            }
+
+            pSamples[acked++] = nowNs - pSlot->sendNs;
+            pSlot->seq = UINT64_MAX;
+        }
+
+        recvLen -= pos;
+        if (recvLen > 0) {
+            memmove(recvBuff, recvBuff + pos, recvLen);
+        }
+    }
+
+    elapsedNs = VerifyFrame_NowNs() - startNs;
+    fprintf(stdout, "window %5d: %d msgs in %.03f ms, %.0f msg/s\n",
+            window, _msgCount, (double) elapsedNs / 1000000,
+            elapsedNs > 0 ? (double) _msgCount * 1000000000 / elapsedNs : 0);
+
+    if (_windowCount > 1) {
+        snprintf(label, sizeof(label), ".w%d", window);
+    } else {
+        label[0] = '\0';
+    }
+    if (_SendClient_DumpSamples(label, pSamples, _msgCount) < 0) {
+        return -1;
+    }
+
+    snprintf(label, sizeof(label), "window %5d: rtt", window);
+    _SendClient_PrintLatency(label, pSamples, _msgCount);
+    return 0;
+}
+
+
+/**
+ * 依次以各个窗口大小执行请求/应答测试
+ */
+static int32
+_SendClient_WindowMain(int32 socketFd, char *pMsg, int32 frameSize) {
+    _SendClientSlotT    *pRing = NULL;
+    int64               *pSamples = NULL;
+    uint64_t            nextSeq = 0;
+    int32               ringSize = 1;
+    int32               ret = 0;
+    int32               i = 0;
+
+    for (i = 0; i < _windowCount; i++) {
+        while (ringSize < _windows[i]) {
+            ringSize <<= 1;
+        }
+    }
+
+    pRing = malloc(ringSize * sizeof(_SendClientSlotT));
+    pSamples = malloc(_msgCount * sizeof(int64));
+    if (pRing == NULL || pSamples == NULL) {
+        fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+        ret = -1;
+        goto ON_END;
+    }
+
+    for (i = 0; i < ringSize; i++) {
+        pRing[i].seq = UINT64_MAX;
+        pRing[i].sendNs = 0;
+    }
+
+    for (i = 0; i < _windowCount && ret == 0; i++) {
+        ret = _SendClient_RunWindow(socketFd, pMsg, frameSize, _windows[i],
+                pRing, ringSize - 1, pSamples, &nextSeq);
+    }
+
+ON_END:
+    free(pRing);
+    free(pSamples);
+    return ret;
+}
+
+
+/**
+ * 建连测试中每个线程的任务
+ */
+typedef struct _SendClientConnTask {
+    pthread_t           thread;
+    /** 服务端地址 */
+    struct sockaddr_in  *pServerAddr;
+    /** 建连耗时样本 (纳秒) */
+    int64               *pSetup;
+    /** 首字节耗时样本 (纳秒) */
+    int64               *pFirst;
+    /** 需要建立的连接数 */
+    int32               count;
+    /** 成功的连接数 */
+    int32               okCount;
+    /** 失败的连接数 */
+    int32               failCount;
+} _SendClientConnTaskT;
+
+
+/**
+ * 建立一个连接并完成一次 1 字节的请求/应答
+ *
+ * - setup: 从 socket() 到 connect() 返回 (启用 TCP_FASTOPEN 时为 sendto() 返回)
+ * - first: 从 socket() 到收到服务端的第一个字节
+ *
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_SendClient_ConnectOnce(const struct sockaddr_in *pServerAddr,
+        int64 *pSetupNs, int64 *pFirstNs) {
+    struct linger       lingerVal = {1, 0};
+    int32               socketFd = -1;
+    int32               ret = 0;
+    int64               startNs = VerifyFrame_NowNs();
+    char                byte = 'A';
+
+    socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (socketFd < 0) {
+        fprintf(stderr, "Create socket failed: %d - %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    if (_rstClose) {
+        setsockopt(socketFd, SOL_SOCKET, SO_LINGER, &lingerVal, sizeof(lingerVal));
+    }
+
+    if (_fastopen) {
+        ret = sendto(socketFd, &byte, 1, MSG_FASTOPEN | MSG_NOSIGNAL,
+                (const struct sockaddr *) pServerAddr, sizeof(*pServerAddr));
+        if (ret != 1) {
+            fprintf(stderr, "sendto(MSG_FASTOPEN) failed: %d - %s\n",
+                    errno, strerror(errno));
+            goto ON_ERROR;
+        }
+        *pSetupNs = VerifyFrame_NowNs() - startNs;
+    } else {
+        if (connect(socketFd, (const struct sockaddr *) pServerAddr,
+                sizeof(*pServerAddr)) < 0) {
+            fprintf(stderr, "Connect failed: %d - %s\n", errno, strerror(errno));
+            goto ON_ERROR;
+        }
+        *pSetupNs = VerifyFrame_NowNs() - startNs;
+
+        if (send(socketFd, &byte, 1, MSG_NOSIGNAL) != 1) {
+            fprintf(stderr, "Send failed: %d - %s\n", errno, strerror(errno));
+            goto ON_ERROR;
+        }
+    }
+
+    do {
+        ret = recv(socketFd, &byte, 1, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret != 1) {
+        fprintf(stderr, "Recv first byte failed: %d - %s\n",
+                errno, ret == 0 ? "closed by peer" : strerror(errno));
+        goto ON_ERROR;
+    }
+    *pFirstNs = VerifyFrame_NowNs() - startNs;
+
+    close(socketFd);
+    return 0;
+
+ON_ERROR:
+    close(socketFd);
+    return -1;
+}
+
+
+static void *
+_SendClient_ConnectThread(void *pArg) {
+    _SendClientConnTaskT    *pTask = (_SendClientConnTaskT *) pArg;
+    int32                   i = 0;
+
+    for (i = 0; i < pTask->count; i++) {
+        if (_SendClient_ConnectOnce(pTask->pServerAddr,
+                &pTask->pSetup[pTask->okCount],
+                &pTask->pFirst[pTask->okCount]) == 0) {
+            pTask->okCount++;
+        } else {
+            pTask->failCount++;
+        }
+
+        if (_intervalUs > 0) {
+            usleep(_intervalUs);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * 建连测试: 以 _concurrency 个线程共建立 _msgCount 个连接,
+ * 输出建连速率以及建连耗时和首字节耗时的分布
+ */
+static int32
+_SendClient_ConnectMain(void) {
+    _SendClientConnTaskT    *pTasks = NULL;
+    struct sockaddr_in      serverAddr;
+    int64                   *pSetup = NULL;
+    int64                   *pFirst = NULL;
+    int64                   startNs = 0;
+    int64                   elapsedNs = 0;
+    int32                   okCount = 0;
+    int32                   failCount = 0;
+    int32                   offset = 0;
+    int32                   ret = -1;
+    int32                   i = 0;
+
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(_port);
+    if (inet_pton(AF_INET, _pIpAddr, &serverAddr.sin_addr) <= 0) {
+        fprintf(stderr, "inet_pton error for %s\n", _pIpAddr);
+        return -1;
+    }
+
+    pTasks = calloc(_concurrency, sizeof(_SendClientConnTaskT));
+    pSetup = malloc(_msgCount * sizeof(int64));
+    pFirst = malloc(_msgCount * sizeof(int64));
+    if (pTasks == NULL || pSetup == NULL || pFirst == NULL) {
+        fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+        goto ON_END;
+    }
+
+    startNs = VerifyFrame_NowNs();
+    for (i = 0; i < _concurrency; i++) {
+        pTasks[i].pServerAddr = &serverAddr;
+        pTasks[i].pSetup = pSetup + offset;
+        pTasks[i].pFirst = pFirst + offset;
+        pTasks[i].count = _msgCount / _concurrency
+                + (i < _msgCount % _concurrency ? 1 : 0);
+        offset += pTasks[i].count;
+
+        if (pthread_create(&pTasks[i].thread, NULL,
+                _SendClient_ConnectThread, &pTasks[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            exit(-1);
+        }
+    }
+
+    for (i = 0; i < _concurrency; i++) {
+        pthread_join(pTasks[i].thread, NULL);
+    }
+    elapsedNs = VerifyFrame_NowNs() - startNs;
+
+    /* 将各线程的成功样本合并到数组的前部 */
+    for (i = 0; i < _concurrency; i++) {
+        memmove(pSetup + okCount, pTasks[i].pSetup,
+                pTasks[i].okCount * sizeof(int64));
+        memmove(pFirst + okCount, pTasks[i].pFirst,
+                pTasks[i].okCount * sizeof(int64));
+        okCount += pTasks[i].okCount;
+        failCount += pTasks[i].failCount;
+    }
+
+    fprintf(stdout, "connect: %d ok, %d failed, concurrency %d, "
+            "in %.03f ms, %.0f conn/s\n",
+            okCount, failCount, _concurrency, (double) elapsedNs / 1000000,
+            elapsedNs > 0 ? (double) okCount * 1000000000 / elapsedNs : 0);
+    if (_SendClient_DumpSamples(".setup", pSetup, okCount) < 0
+            || _SendClient_DumpSamples(".first", pFirst, okCount) < 0) {
+        goto ON_END;
+    }
+
+    _SendClient_PrintLatency("connect: setup     ", pSetup, okCount);
+    _SendClient_PrintLatency("connect: first-byte", pFirst, okCount);
+    ret = failCount > 0 ? -1 : 0;
+
+ON_END:
+    free(pTasks);
+    free(pSetup);
+    free(pFirst);
+    return ret;
+}
+
+
+/**
+ * UDP 测试的接收线程
+ */
+typedef struct _SendClientUdpRecv {
+    pthread_t           thread;
+    int32               socketFd;
+    /** recvmmsg 的批量大小 */
+    int32               batch;
+    struct mmsghdr      *pMsgs;
+    struct iovec        *pIovs;
+    char                *pBuffs;
+    char                *pControls;
+
+    /** 本轮的起始序号及消息数 */
+    uint64_t            startSeq;
+    int32               count;
+    /** 延时样本 (纳秒), 未收到的为 -1 */
+    int64               *pSamples;
+    volatile int32      stop;
+
+    /** 本轮的统计 */
+    int64               received;
+    int64               duplicated;
+    int64               reordered;
+    /** 上一轮等待结束后才到达的应答 (已计入上一轮的丢包) */
+    int64               stale;
+    int64               rxqDrops;
+    uint64_t            maxSeq;
+    int32               hasMaxSeq;
+    /** 内核 SO_RXQ_OVFL 计数的最近值 (跨轮累计) */
+    uint32_t            lastOvfl;
+} _SendClientUdpRecvT;
+
+
+static void *
+_SendClient_UdpRecvThread(void *pArg) {
+    _SendClientUdpRecvT *pRecv = (_SendClientUdpRecvT *) pArg;
+    VerifyFrameHeadT    head;
+    struct cmsghdr      *pCmsg = NULL;
+    uint32_t            ovfl = 0;
+    uint64_t            seq = 0;
+    int64               nowNs = 0;
+    int32               count = 0;
+    int32               i = 0;
+
+    while (! pRecv->stop) {
+        for (i = 0; i < pRecv->batch; i++) {
+            pRecv->pMsgs[i].msg_hdr.msg_controllen = SEND_CLIENT_UDP_CTRL_SIZE;
+        }
+
+        count = recvmmsg(pRecv->socketFd, pRecv->pMsgs, pRecv->batch,
+                MSG_WAITFORONE, NULL);
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                fprintf(stderr, "recvmmsg failed: %d - %s\n", errno, strerror(errno));
+                break;
+            }
+            continue;
+        }
+
+        nowNs = VerifyFrame_NowNs();
+        for (i = 0; i < count; i++) {
+            for (pCmsg = CMSG_FIRSTHDR(&pRecv->pMsgs[i].msg_hdr); pCmsg;
+                    pCmsg = CMSG_NXTHDR(&pRecv->pMsgs[i].msg_hdr, pCmsg)) {
+                if (pCmsg->cmsg_level == SOL_SOCKET
+                        && pCmsg->cmsg_type == SO_RXQ_OVFL) {
+                    memcpy(&ovfl, CMSG_DATA(pCmsg), sizeof(ovfl));
+                    pRecv->rxqDrops += (uint32_t) (ovfl - pRecv->lastOvfl);
+                    pRecv->lastOvfl = ovfl;
+                }
+            }
+
+            if (pRecv->pMsgs[i].msg_len < sizeof(head)) {
+                continue;
+            }
+
+            memcpy(&head, pRecv->pIovs[i].iov_base, sizeof(head));
+            seq = be64toh(head.seq);
+            if (seq < pRecv->startSeq || seq - pRecv->startSeq >= (uint64_t) pRecv->count) {
+                pRecv->stale++;
+                continue;
+            }
+
+            if (pRecv->pSamples[seq - pRecv->startSeq] >= 0) {
+                pRecv->duplicated++;
+                continue;
+            }
+
+            pRecv->pSamples[seq - pRecv->startSeq] = nowNs - head.sendNs;
+            pRecv->received++;
+            if (pRecv->hasMaxSeq && seq < pRecv->maxSeq) {
+                pRecv->reordered++;
+            } else {
+                pRecv->maxSeq = seq;
+                pRecv->hasMaxSeq = 1;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * 以指定的速率和批量大小发送一轮 UDP 消息, 并统计丢包率和往返延时
+ *
+ * 服务端对每个数据报回送帧头, 丢包按序号统计 (包含往返两个方向).
+ *
+ * @param   socketFd        UDP socket
+ * @param   pSendMsgs       发送用的 mmsghdr (至少 batch 个, 各自指向独立的帧缓存和目的地址)
+ * @param   rate            发送速率 (消息/秒), 0 表示不限速
+ * @param   batch           sendmmsg 的批量大小
+ * @param   pRecv           接收线程的上下文
+ * @param   pNextSeq        下一个消息序号 (各轮之间连续)
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_SendClient_RunUdp(int32 socketFd, struct mmsghdr *pSendMsgs,
+        int32 rate, int32 batch,
+        _SendClientUdpRecvT *pRecv, uint64_t *pNextSeq) {
+    int64               startNs = 0;
+    int64               elapsedNs = 0;
+    int64               nextSendNs = 0;
+    int64               nowNs = 0;
+    int64               intervalNs = rate > 0 ? (int64) batch * 1000000000 / rate : 0;
+    int64               sendErrors = 0;
+    int64               paceResets = 0;
+    double              offeredRate = 0;
+    int32               attempted = 0;
+    int32               sent = 0;
+    int32               okCount = 0;
+    int32               n = 0;
+    int32               done = 0;
+    int32               ret = 0;
+    int32               i = 0;
+    char                label[64];
+
+    for (i = 0; i < _msgCount; i++) {
+        pRecv->pSamples[i] = -1;
+    }
+    pRecv->startSeq = *pNextSeq;
+    pRecv->count = _msgCount;
+    pRecv->received = 0;
+    pRecv->duplicated = 0;
+    pRecv->reordered = 0;
+    pRecv->stale = 0;
+    pRecv->rxqDrops = 0;
+    pRecv->hasMaxSeq = 0;
+    pRecv->stop = 0;
+
+    if (pthread_create(&pRecv->thread, NULL, _SendClient_UdpRecvThread, pRecv) != 0) {
+        fprintf(stderr, "pthread_create failed\n");
+        return -1;
+    }
+
+    startNs = VerifyFrame_NowNs();
+    nextSendNs = startNs;
+    while (attempted < _msgCount) {
+        if (rate > 0) {
+            while ((nowNs = VerifyFrame_NowNs()) < nextSendNs) {
+                ;
+            }
+
+            /* 落后超过一个批次时重置发送计划, 避免追赶时的突发 */
+            if (nowNs - nextSendNs > intervalNs) {
+                nextSendNs = nowNs;
+                paceResets++;
+            }
+            nextSendNs += intervalNs;
+        }
+
+        n = _msgCount - attempted < batch ? _msgCount - attempted : batch;
+        nowNs = VerifyFrame_NowNs();
+        for (i = 0; i < n; i++) {
+            VerifyFrame_SetHead(
+                    (VerifyFrameHeadT *) pSendMsgs[i].msg_hdr.msg_iov->iov_base,
+                    _msgSize, 0, (*pNextSeq)++, nowNs);
+        }
+
+        for (done = 0; done < n; ) {
+            ret = sendmmsg(socketFd, pSendMsgs + done, n - done, 0);
+            if (ret > 0) {
+                done += ret;
+                sent += ret;
+            } else if (errno == ENOBUFS || errno == EAGAIN) {
+                /* 本地发送队列溢出, 计入发送失败, 不计入已发送和丢包 */
+                sendErrors++;
+                done++;
+            } else if (errno != EINTR) {
+                fprintf(stderr, "sendmmsg failed: %d - %s\n", errno, strerror(errno));
+                pRecv->stop = 1;
+                pthread_join(pRecv->thread, NULL);
+                return -1;
+            }
+        }
+        attempted += n;
+    }
+    elapsedNs = VerifyFrame_NowNs() - startNs;
+    offeredRate = elapsedNs > 0 ? (double) attempted * 1000000000 / elapsedNs : 0;
+
+    /* 等待在途的应答 */
+    usleep(_drainMs * 1000);
+    pRecv->stop = 1;
+    pthread_join(pRecv->thread, NULL);
+
+    for (i = 0; i < _msgCount; i++) {
+        if (pRecv->pSamples[i] >= 0) {
+            pRecv->pSamples[okCount++] = pRecv->pSamples[i];
+        }
+    }
+
+    fprintf(stdout, "udp rate %8d batch %3d: sent %d in %.03f ms (%.0f msg/s), "
+            "lost %lld (%.03f%%), reordered %lld, dup %lld, stale %lld, "
+            "send errors %lld, client rxq drops %lld\n",
+            rate, batch, sent, (double) elapsedNs / 1000000, offeredRate,
+            (long long) (sent - pRecv->received),
+            sent > 0 ? (double) (sent - pRecv->received) * 100 / sent : 0,
+            (long long) pRecv->reordered, (long long) pRecv->duplicated,
+            (long long) pRecv->stale,
+            (long long) sendErrors, (long long) pRecv->rxqDrops);
+
+    if (rate > 0 && offeredRate < rate * 0.99) {
+        fprintf(stdout, "udp rate %8d batch %3d: target rate not reached "
+                "(%.0f msg/s offered, schedule reset %lld times)\n",
+                rate, batch, offeredRate, (long long) paceResets);
+    }
+
+    if (_rateCount * _batchCount > 1) {
+        snprintf(label, sizeof(label), ".r%d.b%d", rate, batch);
+    } else {
+        label[0] = '\0';
+    }
+    if (_SendClient_DumpSamples(label, pRecv->pSamples, okCount) < 0) {
+        return -1;
+    }
+
+    snprintf(label, sizeof(label), "udp rate %8d batch %3d: rtt", rate, batch);
+    _SendClient_PrintLatency(label, pRecv->pSamples, okCount);
+    return 0;
+}
+
+
+/**
+ * UDP 测试: 依次以各个发送速率和批量大小执行, 输出丢包率和往返延时分位数
+ */
+static int32
+_SendClient_UdpMain(void) {
+    _SendClientUdpRecvT udpRecv;
+    struct sockaddr_in  destAddr;
+    const char          *pDest = NULL;
+    struct ip_mreqn     mreq;
+    struct timeval      timeout = {0, 10000};
+    struct mmsghdr      *pSendMsgs = NULL;
+    struct iovec        *pSendIovs = NULL;
+    char                *pSendBuffs = NULL;
+    uint64_t            nextSeq = 0;
+    int32               maxBatch = 1;
+    int32               socketFd = -1;
+    int32               iOptVal = 1;
+    int32               ret = -1;
+    int32               i = 0;
+    int32               j = 0;
+
+    memset(&udpRecv, 0, sizeof(udpRecv));
+    memset(&destAddr, 0, sizeof(destAddr));
+    destAddr.sin_family = AF_INET;
+    destAddr.sin_port = htons(_port);
+    pDest = _pMcastGroup ? _pMcastGroup : _pIpAddr;
+    if (pDest == NULL || inet_pton(AF_INET, pDest, &destAddr.sin_addr) <= 0) {
+        fprintf(stderr, "inet_pton error for %s\n", pDest ? pDest : "(null)");
+        return -1;
+    }
+
+    for (i = 0; i < _batchCount; i++) {
+        if (_batches[i] > maxBatch) {
+            maxBatch = _batches[i];
+        }
+    }
+
+    socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0) {
+        fprintf(stderr, "Create socket failed: %d - %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    if (_sndbuf > 0 && setsockopt(socketFd, SOL_SOCKET, SO_SNDBUF,
+            &_sndbuf, sizeof(_sndbuf)) < 0) {
+        fprintf(stdout, "setsockopt SO_SNDBUF failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (_rcvbuf > 0 && setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF,
+            &_rcvbuf, sizeof(_rcvbuf)) < 0) {
+        fprintf(stdout, "setsockopt SO_RCVBUF failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (setsockopt(socketFd, SOL_SOCKET, SO_RXQ_OVFL, &iOptVal, sizeof(iOptVal)) < 0) {
+        fprintf(stdout, "setsockopt SO_RXQ_OVFL failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    /* 接收线程通过超时检查结束标志 */
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (_pMcastGroup) {
+        if (setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_LOOP,
+                &iOptVal, sizeof(iOptVal)) < 0) {
+            fprintf(stdout, "setsockopt IP_MULTICAST_LOOP failed! %d - %s\n",
+                    errno, strerror(errno));
+        }
+
+        if (_pMcastIf) {
+            memset(&mreq, 0, sizeof(mreq));
+            if (inet_pton(AF_INET, _pMcastIf, &mreq.imr_address) <= 0) {
+                fprintf(stderr, "inet_pton error for %s\n", _pMcastIf);
+                goto ON_END;
+            }
+            if (setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_IF,
+                    &mreq, sizeof(mreq)) < 0) {
+                fprintf(stderr, "setsockopt IP_MULTICAST_IF failed: %d - %s\n",
+                        errno, strerror(errno));
+                goto ON_END;
+            }
+        }
+    }
+
+    pSendMsgs = calloc(maxBatch, sizeof(struct mmsghdr));
+    pSendIovs = calloc(maxBatch, sizeof(struct iovec));
+    pSendBuffs = malloc((int64) maxBatch * _msgSize);
+    udpRecv.pMsgs = calloc(maxBatch, sizeof(struct mmsghdr));
+    udpRecv.pIovs = calloc(maxBatch, sizeof(struct iovec));
+    udpRecv.pBuffs = malloc(maxBatch * SEND_CLIENT_UDP_RECV_SIZE);
+    udpRecv.pControls = calloc(maxBatch, SEND_CLIENT_UDP_CTRL_SIZE);
+    udpRecv.pSamples = malloc(_msgCount * sizeof(int64));
+    if (pSendMsgs == NULL || pSendIovs == NULL || pSendBuffs == NULL
+            || udpRecv.pMsgs == NULL || udpRecv.pIovs == NULL || udpRecv.pBuffs == NULL
+            || udpRecv.pControls == NULL || udpRecv.pSamples == NULL) {
+        fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+        goto ON_END;
+    }
+
+    memset(pSendBuffs, 'A', (int64) maxBatch * _msgSize);
+    for (i = 0; i < maxBatch; i++) {
+        pSendIovs[i].iov_base = pSendBuffs + (int64) i * _msgSize;
+        pSendIovs[i].iov_len = _msgSize;
+        pSendMsgs[i].msg_hdr.msg_name = &destAddr;
+        pSendMsgs[i].msg_hdr.msg_namelen = sizeof(destAddr);
+        pSendMsgs[i].msg_hdr.msg_iov = &pSendIovs[i];
+        pSendMsgs[i].msg_hdr.msg_iovlen = 1;
+
+        udpRecv.pIovs[i].iov_base = udpRecv.pBuffs + i * SEND_CLIENT_UDP_RECV_SIZE;
+        udpRecv.pIovs[i].iov_len = SEND_CLIENT_UDP_RECV_SIZE;
+        udpRecv.pMsgs[i].msg_hdr.msg_iov = &udpRecv.pIovs[i];
+        udpRecv.pMsgs[i].msg_hdr.msg_iovlen = 1;
+        udpRecv.pMsgs[i].msg_hdr.msg_control = udpRecv.pControls + i * SEND_CLIENT_UDP_CTRL_SIZE;
+    }
+    udpRecv.socketFd = socketFd;
+
+    if (_cpu >= 0) {
+        _SendClient_SetCpuAffinity(_cpu);
+    }
+
+    ret = 0;
+    for (i = 0; i < _rateCount && ret == 0; i++) {
+        for (j = 0; j < _batchCount && ret == 0; j++) {
+            udpRecv.batch = _batches[j];
+            ret = _SendClient_RunUdp(socketFd, pSendMsgs,
+                    _rates[i], _batches[j], &udpRecv, &nextSeq);
+        }
+    }
+
+ON_END:
+    free(pSendMsgs);
+    free(pSendIovs);
+    free(pSendBuffs);
+    free(udpRecv.pMsgs);
+    free(udpRecv.pIovs);
+    free(udpRecv.pBuffs);
+    free(udpRecv.pControls);
+    free(udpRecv.pSamples);
+    close(socketFd);
+    return ret;
+}
+
+
 /**
  * API接口库示例程序的主函数
  */
 int32
 _SendClient_Main(void) {
     int64               totalLatency = 0;
+    int64               latency = 0;
+    int64               *pSamples = NULL;
     int32               msgCount = _msgCount;
-    char                *pMsg = malloc(_msgSize);
+    char                *pMsg = NULL;
     int32               socketFd = -1;
     int32               socketFlag = 0;
     int32               iOptVal = 0;
     socklen_t           optLen = sizeof(iOptVal);
     
+    if (_mode == SEND_CLIENT_MODE_CONNECT) {
+        return _SendClient_ConnectMain();
+    }
+
+    if (_mode == SEND_CLIENT_MODE_UDP) {
+        if (_msgSize < (int32) sizeof(VerifyFrameHeadT)) {
+            _msgSize = sizeof(VerifyFrameHeadT);
+        } else if (_msgSize > SEND_CLIENT_MAX_UDP_SIZE) {
+            _msgSize = SEND_CLIENT_MAX_UDP_SIZE;
+        }
+        return _SendClient_UdpMain();
+    }
+
+    if (_mode == SEND_CLIENT_MODE_WINDOW
+            && _msgSize < (int32) sizeof(VerifyFrameHeadT)) {
+        _msgSize = sizeof(VerifyFrameHeadT);
+    }
+
+    pMsg = malloc(_msgSize);
     if (pMsg == NULL) {
         fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
         goto ON_ERROR;
@@ -281,9 +1180,31 @@ _SendClient_Main(void) {
         }
     }
 
+    if (_mode == SEND_CLIENT_MODE_WINDOW) {
+        if (_SendClient_WindowMain(socketFd, pMsg, _msgSize) < 0) {
+            goto ON_ERROR;
+        }
+
+        close(socketFd);
+        free(pMsg);
+        return 0;
+    }
+
+    if (_pOutputFile) {
+        pSamples = malloc(_msgCount * sizeof(int64));
+        if (pSamples == NULL) {
+            fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+            goto ON_ERROR;
+        }
+    }
+
     do {
         /* 以 12.67元 购买 浦发银行(600000) 100股 */
-        totalLatency += _SendClient_Send(socketFd, pMsg, _msgSize);
+        latency = _SendClient_Send(socketFd, pMsg, _msgSize);
+        totalLatency += latency;
+        if (pSamples) {
+            pSamples[_msgCount - msgCount] = latency * 1000;
+        }
         if (_intervalUs > 0) {
             usleep(_intervalUs);
         }
@@ -291,6 +1212,11 @@ _SendClient_Main(void) {
 
     fprintf(stdout, "average cost is: %.02f us\n", (double) totalLatency / _msgCount);
 
+    if (pSamples) {
+        _SendClient_DumpSamples("", pSamples, _msgCount);
+        free(pSamples);
+    }
+
 
     close(socketFd);
     return 0;
@@ -305,9 +1231,48 @@ ON_ERROR:
 }
 
 
+/**
+ * 解析逗号分隔的整数列表, 如: 1,4,16,64
+ *
+ * @param   pStr            待解析的字符串 (会被修改)
+ * @param   pValues         解析结果 (最多 SEND_CLIENT_MAX_LIST 个)
+ * @param   pCount          解析出的个数
+ * @param   minValue        允许的最小值
+ * @param   maxValue        允许的最大值
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_SendClient_ParseList(char *pStr, int32 *pValues, int32 *pCount,
+        int32 minValue, int32 maxValue) {
+    char                *pToken = NULL;
+    char                *pSavePtr = NULL;
+    int32               count = 0;
+
+    for (pToken = strtok_r(pStr, ",", &pSavePtr); pToken;
+            pToken = strtok_r(NULL, ",", &pSavePtr)) {
+        if (count >= SEND_CLIENT_MAX_LIST) {
+            return -1;
+        }
+
+        pValues[count] = strtol(pToken, NULL, 10);
+        if (pValues[count] < minValue || pValues[count] > maxValue) {
+            return -1;
+        }
+        count++;
+    }
+
+    if (count == 0) {
+        return -1;
+    }
+
+    *pCount = count;
+    return 0;
+}
+
+
 int
 main(int argc, char *argv[]) {
-    static const char       short_options[] = "i:p:m:n:d:c:t:s:b:";
+    static const char       short_options[] = "i:p:m:n:d:c:t:s:b:M:w:k:f:L:o:r:B:g:I:R:W:";
     static struct option    long_options[] = {
         { "ipAddr",             1,  NULL,   'i' },
         { "port",               1,  NULL,   'p' },
@@ -318,6 +1283,18 @@ main(int argc, char *argv[]) {
         { "tcp-nodelay",        1,  NULL,   't' },
         { "snd-buf",            1,  NULL,   's' },
         { "block",              1,  NULL,   'b' },
+        { "mode",               1,  NULL,   'M' },
+        { "window",             1,  NULL,   'w' },
+        { "concurrency",        1,  NULL,   'k' },
+        { "fastopen",           1,  NULL,   'f' },
+        { "rst-close",          1,  NULL,   'L' },
+        { "output",             1,  NULL,   'o' },
+        { "rate",               1,  NULL,   'r' },
+        { "batch",              1,  NULL,   'B' },
+        { "mcast-group",        1,  NULL,   'g' },
+        { "mcast-if",           1,  NULL,   'I' },
+        { "rcv-buf",            1,  NULL,   'R' },
+        { "drain-ms",           1,  NULL,   'W' },
         { 0, 0, 0, 0 }
     };
 
@@ -438,6 +1415,134 @@ main(int argc, char *argv[]) {
             }
             break;
 
+        case 'M':
+            if (optarg) {
+                if (strcmp(optarg, "send") == 0) {
+                    _mode = SEND_CLIENT_MODE_SEND;
+                } else if (strcmp(optarg, "window") == 0) {
+                    _mode = SEND_CLIENT_MODE_WINDOW;
+                } else if (strcmp(optarg, "connect") == 0) {
+                    _mode = SEND_CLIENT_MODE_CONNECT;
+                } else if (strcmp(optarg, "udp") == 0) {
+                    _mode = SEND_CLIENT_MODE_UDP;
+                } else {
+                    fprintf(stderr, "ERROR: Invalid mode value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid mode params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'w':
+            if (! optarg || _SendClient_ParseList(optarg, _windows,
+                    &_windowCount, 1, SEND_CLIENT_MAX_WINDOW) < 0) {
+                fprintf(stderr, "ERROR: Invalid window params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'k':
+            if (optarg) {
+                _concurrency = strtol(optarg, NULL, 10);
+                if (_concurrency < 1 || _concurrency > 1024) {
+                    fprintf(stderr, "ERROR: Invalid concurrency value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid concurrency params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'f':
+            if (optarg) {
+                _fastopen = strtol(optarg, NULL, 10);
+            } else {
+                fprintf(stderr, "ERROR: Invalid fastopen params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'L':
+            if (optarg) {
+                _rstClose = strtol(optarg, NULL, 10);
+            } else {
+                fprintf(stderr, "ERROR: Invalid rst-close params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'o':
+            if (optarg && strlen(optarg) > 0) {
+                _pOutputFile = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid output params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'r':
+            if (! optarg || _SendClient_ParseList(optarg, _rates,
+                    &_rateCount, 0, 100000000) < 0) {
+                fprintf(stderr, "ERROR: Invalid rate params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'B':
+            if (! optarg || _SendClient_ParseList(optarg, _batches,
+                    &_batchCount, 1, SEND_CLIENT_MAX_BATCH) < 0) {
+                fprintf(stderr, "ERROR: Invalid batch params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'g':
+            if (optarg && strlen(optarg) > 0) {
+                _pMcastGroup = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid mcast-group params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'I':
+            if (optarg && strlen(optarg) > 0) {
+                _pMcastIf = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid mcast-if params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'R':
+            if (optarg) {
+                _rcvbuf = strtol(optarg, NULL, 10);
+                if (_rcvbuf <= 0) {
+                    fprintf(stderr, "ERROR: Invalid rcv-buf value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid rcv-buf params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'W':
+            if (optarg) {
+                _drainMs = strtol(optarg, NULL, 10);
+                if (_drainMs < 0 || _drainMs > 100000) {
+                    fprintf(stderr, "ERROR: Invalid drain-ms value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid drain-ms params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
         default:
             fprintf(stderr, "ERROR: Invalid options! ('%c')\n\n", c);
             return -EINVAL;
@@ -0,0 +1,686 @@
+/*
+ * Copyright 2016 the original author or authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    compare.c
+ *
+ * 比较两组延时测试结果 (A/B), 判断是否存在统计上显著的延时回退
+ *
+ * 输入文件每行为 "<延时(纳秒)>" 或 "<延时(纳秒)> <次数>", 即 client -o 输出的原始样本
+ * 或者直方图, 以 '#' 开头的行被忽略. 输入以流的方式读入对数分桶的直方图
+ * (相对精度约 1.6%), 内存占用与样本个数无关.
+ *
+ * - 各分位数的差值及其 bootstrap 置信区间 (对直方图做多项式重抽样)
+ * - Mann-Whitney U 检验 (含结的修正) 及 Kolmogorov-Smirnov 检验
+ * - 指定分位数回退超过阈值且置信区间下限大于0时, 以 1 退出
+ *
+ * @version 1.0 2026/10/19
+ * @since   2026/10/19
+ */
+
+
+#define _GNU_SOURCE             /* See feature_test_macros(7) */
+
+#include    <stdio.h>
+#include    <stdint.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <errno.h>
+#include    <math.h>
+
+#include    <getopt.h>
+
+
+typedef int64_t         int64;
+typedef int32_t         int32;
+typedef uint64_t        uint64;
+
+
+/* 对数分桶: 小于 2^(SUB_BITS+1) 的值精确计数, 其余每个 2 的幂区间分为 2^SUB_BITS 个桶 */
+#define COMPARE_SUB_BITS            6
+#define COMPARE_SUB_COUNT           (1 << COMPARE_SUB_BITS)
+#define COMPARE_MAX_EXP             47
+#define COMPARE_BUCKET_COUNT        ((COMPARE_MAX_EXP - COMPARE_SUB_BITS + 2) * COMPARE_SUB_COUNT)
+
+#define COMPARE_MAX_PERCENTILES     16
+
+
+/**
+ * 一组测试结果的直方图
+ */
+typedef struct _CompareHist {
+    /** 文件名 */
+    const char          *pPath;
+    /** 各桶的样本个数 */
+    int64               counts[COMPARE_BUCKET_COUNT];
+    /** 非空桶的下标 (升序) */
+    int32               nonEmpty[COMPARE_BUCKET_COUNT];
+    /** 非空桶的个数 */
+    int32               nonEmptyCount;
+    /** 样本总数 */
+    int64               total;
+    /** 样本之和 (纳秒) */
+    double              sum;
+} _CompareHistT;
+
+
+char            *_pBasePath = NULL;
+char            *_pTestPath = NULL;
+double          _pcts[COMPARE_MAX_PERCENTILES] = {50, 90, 99, 99.9};
+int32           _pctCount = 4;
+double          _gatePct = 99;
+double          _thresholdPct = -1;
+double          _confidence = 95;
+int32           _resamples = 1000;
+uint64          _seed = 88172645463325252ULL;
+
+
+static inline int32
+_Compare_BucketIndex(int64 value) {
+    int32               e = 0;
+
+    if (value < (2 << COMPARE_SUB_BITS)) {
+        return value < 0 ? 0 : (int32) value;
+    }
+
+    e = 63 - __builtin_clzll((uint64) value);
+    if (e > COMPARE_MAX_EXP) {
+        return COMPARE_BUCKET_COUNT - 1;
+    }
+
+    return (e - COMPARE_SUB_BITS + 1) * COMPARE_SUB_COUNT
+            + (int32) (value >> (e - COMPARE_SUB_BITS)) - COMPARE_SUB_COUNT;
+}
+
+
+/**
+ * 返回桶的代表值 (桶区间的中点, 纳秒)
+ */
+static inline double
+_Compare_BucketValue(int32 idx) {
+    int32               e = 0;
+    int64               lower = 0;
+    int64               width = 0;
+
+    if (idx < (2 << COMPARE_SUB_BITS)) {
+        return idx;
+    }
+
+    e = idx / COMPARE_SUB_COUNT + COMPARE_SUB_BITS - 1;
+    width = (int64) 1 << (e - COMPARE_SUB_BITS);
+    lower = (int64) (idx % COMPARE_SUB_COUNT + COMPARE_SUB_COUNT) * width;
+    return lower + (double) (width - 1) / 2;
+}
+
+
+/**
+ * 以流的方式读取结果文件并累加到直方图
+ *
+ * @return  大于等于0，成功；小于0，失败
+ */
+static int32
+_Compare_Load(_CompareHistT *pHist, const char *pPath) {
+    FILE                *fp = NULL;
+    char                line[256];
+    char                *p = NULL;
+    char                *pEnd = NULL;
+    int64               value = 0;
+    int64               count = 0;
+    int64               lineNo = 0;
+    int32               i = 0;
+
+    memset(pHist, 0, sizeof(_CompareHistT));
+    pHist->pPath = pPath;
+
+    fp = fopen(pPath, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Open %s failed: %d - %s\n", pPath, errno, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineNo++;
+
+        for (p = line; *p == ' ' || *p == '\t'; p++) {
+            ;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        errno = 0;
+        value = strtoll(p, &pEnd, 10);
+        if (pEnd == p || errno != 0 || value < 0) {
+            goto ON_BAD_LINE;
+        }
+
+        count = 1;
+        p = pEnd;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p != '\n' && *p != '\r' && *p != '\0') {
+            count = strtoll(p, &pEnd, 10);
+            if (pEnd == p || errno != 0 || count < 0) {
+                goto ON_BAD_LINE;
+            }
+        }
+
+        pHist->counts[_Compare_BucketIndex(value)] += count;
+        pHist->total += count;
+        pHist->sum += (double) value * count;
+    }
+
+    if (ferror(fp)) {
+        fprintf(stderr, "Read %s failed: %d - %s\n", pPath, errno, strerror(errno));
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    if (pHist->total == 0) {
+        fprintf(stderr, "No samples in %s\n", pPath);
+        return -1;
+    }
+
+    for (i = 0; i < COMPARE_BUCKET_COUNT; i++) {
+        if (pHist->counts[i] > 0) {
+            pHist->nonEmpty[pHist->nonEmptyCount++] = i;
+        }
+    }
+
+    return 0;
+
+ON_BAD_LINE:
+    fprintf(stderr, "Invalid sample at %s:%lld\n", pPath, (long long) lineNo);
+    fclose(fp);
+    return -1;
+}
+
+
+/**
+ * 按直方图计算分位数 (最近秩法)
+ *
+ * @param   pHist           直方图 (只使用其非空桶列表)
+ * @param   pCounts         各桶样本个数 (可以是重抽样后的结果)
+ * @param   pct             分位数 (0 ~ 100)
+ * @return  分位数对应的值 (纳秒)
+ */
+static double
+_Compare_Percentile(const _CompareHistT *pHist, const int64 *pCounts,
+        double pct) {
+    int64               rank = (int64) ceil(pct / 100 * pHist->total);
+    int64               cum = 0;
+    int32               idx = 0;
+    int32               i = 0;
+
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    for (i = 0; i < pHist->nonEmptyCount; i++) {
+        idx = pHist->nonEmpty[i];
+        cum += pCounts[idx];
+        if (cum >= rank) {
+            break;
+        }
+    }
+
+    return _Compare_BucketValue(idx);
+}
+
+
+/* xorshift64* 伪随机数 */
+static inline double
+_Compare_Uniform(void) {
+    _seed ^= _seed >> 12;
+    _seed ^= _seed << 25;
+    _seed ^= _seed >> 27;
+    /* 取高 53 位, 结果位于 (0, 1) */
+    return (((_seed * 2685821657736338717ULL) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+
+static inline double
+_Compare_Normal(void) {
+    return sqrt(-2 * log(_Compare_Uniform())) * cos(2 * M_PI * _Compare_Uniform());
+}
+
+
+/**
+ * 二项分布抽样: n*p 较小时用等待时间法, 否则用正态近似
+ */
+static int64
+_Compare_Binomial(int64 n, double p) {
+    double              q = p <= 0.5 ? p : 1 - p;
+    double              lq = 0;
+    int64               x = 0;
+    int64               sum = 0;
+
+    if (n <= 0 || p <= 0) {
+        return 0;
+    } else if (p >= 1) {
+        return n;
+    }
+
+    if (n * q < 30) {
+        lq = log(1 - q);
+        while (1) {
+            sum += (int64) (log(_Compare_Uniform()) / lq) + 1;
+            if (sum > n) {
+                break;
+            }
+            x++;
+        }
+    } else {
+        x = llround(n * q + sqrt(n * q * (1 - q)) * _Compare_Normal());
+        x = x < 0 ? 0 : (x > n ? n : x);
+    }
+
+    return p <= 0.5 ? x : n - x;
+}
+
+
+/**
+ * 对直方图做一次多项式重抽样 (样本总数不变), 结果写入 pCounts
+ */
+static void
+_Compare_Resample(const _CompareHistT *pHist, int64 *pCounts) {
+    int64               n = pHist->total;
+    int64               mass = pHist->total;
+    int64               c = 0;
+    int32               idx = 0;
+    int32               i = 0;
+
+    for (i = 0; i < pHist->nonEmptyCount; i++) {
+        idx = pHist->nonEmpty[i];
+        c = pHist->counts[idx];
+        pCounts[idx] = c >= mass ? n : _Compare_Binomial(n, (double) c / mass);
+        n -= pCounts[idx];
+        mass -= c;
+    }
+}
+
+
+static int
+_Compare_CompareDouble(const void *a, const void *b) {
+    double              x = *(const double *) a;
+    double              y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * Mann-Whitney U 检验 (正态近似, 同一个桶内的样本视为结)
+ *
+ * @param   pZ              z 值 (大于0表示 test 偏大)
+ * @param   pP              双侧 p 值
+ * @param   pProb           P(test > base) 的估计
+ */
+static void
+_Compare_MannWhitney(const _CompareHistT *pBase, const _CompareHistT *pTest,
+        double *pZ, double *pP, double *pProb) {
+    double              nA = pBase->total;
+    double              nB = pTest->total;
+    double              n = nA + nB;
+    double              rankBase = 0;
+    double              rankSum = 0;
+    double              tieSum = 0;
+    double              t = 0;
+    double              uTest = 0;
+    double              sigma = 0;
+    int32               i = 0;
+
+    for (i = 0; i < COMPARE_BUCKET_COUNT; i++) {
+        t = (double) pBase->counts[i] + pTest->counts[i];
+        if (t == 0) {
+            continue;
+        }
+
+        rankSum += pTest->counts[i] * (rankBase + (t + 1) / 2);
+        tieSum += t * t * t - t;
+        rankBase += t;
+    }
+
+    uTest = rankSum - nB * (nB + 1) / 2;
+    sigma = sqrt(nA * nB / 12 * ((n + 1) - tieSum / (n * (n - 1))));
+
+    *pProb = uTest / (nA * nB);
+    *pZ = sigma > 0 ? (uTest - nA * nB / 2) / sigma : 0;
+    *pP = erfc(fabs(*pZ) / M_SQRT2);
+}
+
+
+/**
+ * Kolmogorov-Smirnov 双样本检验 (在桶边界上比较经验分布)
+ *
+ * @param   pD              D 统计量
+ * @param   pP              渐近 p 值
+ */
+static void
+_Compare_KolmogorovSmirnov(const _CompareHistT *pBase,
+        const _CompareHistT *pTest, double *pD, double *pP) {
+    double              cumA = 0;
+    double              cumB = 0;
+    double              d = 0;
+    double              ne = 0;
+    double              lambda = 0;
+    double              term = 0;
+    double              sum = 0;
+    int32               i = 0;
+    int32               k = 0;
+
+    for (i = 0; i < COMPARE_BUCKET_COUNT; i++) {
+        cumA += pBase->counts[i];
+        cumB += pTest->counts[i];
+        if (fabs(cumA / pBase->total - cumB / pTest->total) > d) {
+            d = fabs(cumA / pBase->total - cumB / pTest->total);
+        }
+    }
+
+    ne = (double) pBase->total * pTest->total / (pBase->total + pTest->total);
+    lambda = (sqrt(ne) + 0.12 + 0.11 / sqrt(ne)) * d;
+
+    *pD = d;
+    *pP = 1;
+    if (lambda < 0.2) {
+        return;
+    }
+
+    for (k = 1; k <= 100; k++) {
+        term = 2 * ((k & 1) ? 1 : -1) * exp(-2 * k * k * lambda * lambda);
+        sum += term;
+        if (fabs(term) < 1e-12) {
+            break;
+        }
+    }
+    *pP = sum < 0 ? 0 : (sum > 1 ? 1 : sum);
+}
+
+
+/**
+ * 比较工具的主函数
+ *
+ * @return  0, 未发现回退; 1, 指定分位数出现显著回退; 小于0, 失败
+ */
+static int32
+_Compare_Main(void) {
+    _CompareHistT       *pBase = NULL;
+    _CompareHistT       *pTest = NULL;
+    int64               *pCountsA = NULL;
+    int64               *pCountsB = NULL;
+    double              *pDeltas = NULL;
+    double              valueA = 0;
+    double              valueB = 0;
+    double              delta = 0;
+    double              deltaPct = 0;
+    double              ciLow = 0;
+    double              ciHigh = 0;
+    double              z = 0;
+    double              p = 0;
+    double              prob = 0;
+    double              d = 0;
+    int32               gateIdx = -1;
+    int32               regression = 0;
+    int32               ret = -1;
+    int32               i = 0;
+    int32               r = 0;
+
+    pBase = malloc(sizeof(_CompareHistT));
+    pTest = malloc(sizeof(_CompareHistT));
+    pCountsA = calloc(COMPARE_BUCKET_COUNT, sizeof(int64));
+    pCountsB = calloc(COMPARE_BUCKET_COUNT, sizeof(int64));
+    pDeltas = malloc((int64) _resamples * _pctCount * sizeof(double));
+    if (pBase == NULL || pTest == NULL || pCountsA == NULL
+            || pCountsB == NULL || pDeltas == NULL) {
+        fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+        goto ON_END;
+    }
+
+    if (_Compare_Load(pBase, _pBasePath) < 0
+            || _Compare_Load(pTest, _pTestPath) < 0) {
+        goto ON_END;
+    }
+
+    for (r = 0; r < _resamples; r++) {
+        _Compare_Resample(pBase, pCountsA);
+        _Compare_Resample(pTest, pCountsB);
+        for (i = 0; i < _pctCount; i++) {
+            pDeltas[i * _resamples + r] =
+                    _Compare_Percentile(pTest, pCountsB, _pcts[i])
+                    - _Compare_Percentile(pBase, pCountsA, _pcts[i]);
+        }
+    }
+
+    fprintf(stdout, "base: %s, %lld samples, avg %.02f us\n", pBase->pPath,
+            (long long) pBase->total, pBase->sum / pBase->total / 1000);
+    fprintf(stdout, "test: %s, %lld samples, avg %.02f us\n", pTest->pPath,
+            (long long) pTest->total, pTest->sum / pTest->total / 1000);
+    fprintf(stdout, "\n%-10s %12s %12s %12s %9s   %g%% CI (us)\n",
+            "percentile", "base(us)", "test(us)", "delta(us)", "delta%",
+            _confidence);
+
+    for (i = 0; i < _pctCount; i++) {
+        valueA = _Compare_Percentile(pBase, pBase->counts, _pcts[i]);
+        valueB = _Compare_Percentile(pTest, pTest->counts, _pcts[i]);
+        delta = valueB - valueA;
+        deltaPct = valueA > 0 ? delta * 100 / valueA : 0;
+
+        qsort(pDeltas + i * _resamples, _resamples, sizeof(double),
+                _Compare_CompareDouble);
+        ciLow = pDeltas[i * _resamples
+                + (int32) ((100 - _confidence) / 200 * (_resamples - 1))];
+        ciHigh = pDeltas[i * _resamples
+                + (int32) ((100 + _confidence) / 200 * (_resamples - 1) + 0.5)];
+
+        fprintf(stdout, "p%-9g %12.02f %12.02f %+12.02f %+8.02f%%   [%+.02f, %+.02f]\n",
+                _pcts[i], valueA / 1000, valueB / 1000, delta / 1000, deltaPct,
+                ciLow / 1000, ciHigh / 1000);
+
+        if (_pcts[i] == _gatePct) {
+            gateIdx = i;
+            regression = _thresholdPct >= 0
+                    && deltaPct > _thresholdPct && ciLow > 0;
+        }
+    }
+
+    _Compare_MannWhitney(pBase, pTest, &z, &p, &prob);
+    fprintf(stdout, "\nMann-Whitney U: z = %+.03f, p = %.04g, P(test > base) = %.04f\n",
+            z, p, prob);
+
+    _Compare_KolmogorovSmirnov(pBase, pTest, &d, &p);
+    fprintf(stdout, "Kolmogorov-Smirnov: D = %.04f, p = %.04g\n", d, p);
+
+    if (_thresholdPct >= 0 && gateIdx >= 0) {
+        fprintf(stdout, "\ngate: p%g threshold %+.02f%%: %s\n", _gatePct,
+                _thresholdPct, regression ? "REGRESSION" : "ok");
+    }
+    ret = regression ? 1 : 0;
+
+ON_END:
+    free(pBase);
+    free(pTest);
+    free(pCountsA);
+    free(pCountsB);
+    free(pDeltas);
+    return ret;
+}
+
+
+int
+main(int argc, char *argv[]) {
+    static const char       short_options[] = "a:b:P:g:t:c:r:s:";
+    static struct option    long_options[] = {
+        { "base",               1,  NULL,   'a' },
+        { "test",               1,  NULL,   'b' },
+        { "percentiles",        1,  NULL,   'P' },
+        { "gate-pct",           1,  NULL,   'g' },
+        { "threshold",          1,  NULL,   't' },
+        { "confidence",         1,  NULL,   'c' },
+        { "resamples",          1,  NULL,   'r' },
+        { "seed",               1,  NULL,   's' },
+        { 0, 0, 0, 0 }
+    };
+
+    int32                   option_index = 0;
+    int32                   c = 0;
+    int32                   i = 0;
+    char                    *pToken = NULL;
+    char                    *pSavePtr = NULL;
+
+    optind = 1;
+    opterr = 1;
+    while ((c = getopt_long(argc, argv, short_options,
+            long_options, &option_index)) != EOF) {
+        switch (c) {
+        case 'a':
+            if (optarg && strlen(optarg) > 0) {
+                _pBasePath = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid base params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'b':
+            if (optarg && strlen(optarg) > 0) {
+                _pTestPath = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid test params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'P':
+            if (optarg) {
+                /* 逗号分隔的分位数列表, 如: 50,99,99.9 */
+                _pctCount = 0;
+                for (pToken = strtok_r(optarg, ",", &pSavePtr); pToken;
+                        pToken = strtok_r(NULL, ",", &pSavePtr)) {
+                    if (_pctCount >= COMPARE_MAX_PERCENTILES) {
+                        fprintf(stderr, "ERROR: Too many percentile values!\n\n");
+                        return -EINVAL;
+                    }
+
+                    _pcts[_pctCount] = strtod(pToken, NULL);
+                    if (_pcts[_pctCount] <= 0 || _pcts[_pctCount] > 100) {
+                        fprintf(stderr, "ERROR: Invalid percentile value!\n\n");
+                        return -EINVAL;
+                    }
+                    _pctCount++;
+                }
+
+                if (_pctCount == 0) {
+                    fprintf(stderr, "ERROR: Invalid percentile value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid percentile params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'g':
+            if (optarg) {
+                _gatePct = strtod(optarg, NULL);
+                if (_gatePct <= 0 || _gatePct > 100) {
+                    fprintf(stderr, "ERROR: Invalid gate-pct value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid gate-pct params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 't':
+            if (optarg) {
+                _thresholdPct = strtod(optarg, NULL);
+                if (_thresholdPct < 0) {
+                    fprintf(stderr, "ERROR: Invalid threshold value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid threshold params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'c':
+            if (optarg) {
+                _confidence = strtod(optarg, NULL);
+                if (_confidence <= 0 || _confidence >= 100) {
+                    fprintf(stderr, "ERROR: Invalid confidence value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid confidence params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'r':
+            if (optarg) {
+                _resamples = strtol(optarg, NULL, 10);
+                if (_resamples < 10 || _resamples > 1000000) {
+                    fprintf(stderr, "ERROR: Invalid resamples value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid resamples params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 's':
+            if (optarg) {
+                _seed = strtoull(optarg, NULL, 10);
+                if (_seed == 0) {
+                    fprintf(stderr, "ERROR: Invalid seed value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid seed params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        default:
+            fprintf(stderr, "ERROR: Invalid options! ('%c')\n\n", c);
+            return -EINVAL;
+        }
+    }
+
+    if (_pBasePath == NULL || _pTestPath == NULL) {
+        fprintf(stderr, "ERROR: Both --base and --test are required!\n\n");
+        return -EINVAL;
+    }
+
+    /* 门限分位数不在输出列表中时追加 */
+    for (i = 0; i < _pctCount && _pcts[i] != _gatePct; i++) {
+        ;
+    }
+    if (i == _pctCount && _thresholdPct >= 0) {
+        if (_pctCount >= COMPARE_MAX_PERCENTILES) {
+            fprintf(stderr, "ERROR: Too many percentile values!\n\n");
+            return -EINVAL;
+        }
+        _pcts[_pctCount++] = _gatePct;
+    }
+
+    return _Compare_Main();
+}
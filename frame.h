@@ -0,0 +1,82 @@
+/*
+ * Copyright 2016 the original author or authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    frame.h
+ *
+ * client/server 之间共用的消息帧头定义
+ *
+ * 帧格式: 帧头 + 负载, 帧头中的 msgLen 为包含帧头在内的整个帧长度.
+ * msgLen/flags/seq 以网络字节序传输, sendNs 由发送方填写并由对端原样回传,
+ * 因此只对发送方自身有意义.
+ */
+
+
+#ifndef _VERIFY_FRAME_H
+#define _VERIFY_FRAME_H
+
+
+#include    <stdint.h>
+#include    <time.h>
+#include    <endian.h>
+#include    <arpa/inet.h>
+
+
+/** 应答帧标志 */
+#define VERIFY_FRAME_FLAG_ACK           0x0001
+
+
+/**
+ * 消息帧头
+ */
+typedef struct _VerifyFrameHead {
+    /** 帧长度 (含帧头) */
+    uint32_t            msgLen;
+    /** 帧标志 @see VERIFY_FRAME_FLAG_ACK */
+    uint32_t            flags;
+    /** 消息序号 */
+    uint64_t            seq;
+    /** 发送时间 (发送方的 CLOCK_MONOTONIC, 纳秒) */
+    int64_t             sendNs;
+} VerifyFrameHeadT;
+
+
+/**
+ * 返回当前的单调时钟时间 (纳秒)
+ */
+static inline int64_t
+VerifyFrame_NowNs(void) {
+    struct timespec     ts = {0, 0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/**
+ * 填充帧头 (转换为网络字节序)
+ */
+static inline void
+VerifyFrame_SetHead(VerifyFrameHeadT *pHead, uint32_t msgLen, uint32_t flags,
+        uint64_t seq, int64_t sendNs) {
+    pHead->msgLen = htonl(msgLen);
+    pHead->flags = htonl(flags);
+    pHead->seq = htobe64(seq);
+    pHead->sendNs = sendNs;
+}
+
+
+#endif  /* _VERIFY_FRAME_H */
@@ -43,6 +43,24 @@
 #include    <sys/socket.h>
 #include    <netinet/in.h>
 #include    <arpa/inet.h>
+#include    <netinet/tcp.h>
+#include    <sys/epoll.h>
+
+#include    "frame.h"
+
+
+#define SEND_SERVER_MODE_DRAIN      0       /* 只接收并丢弃数据 */
+#define SEND_SERVER_MODE_ACK        1       /* 按帧解析, 并对每个帧回应答 */
+#define SEND_SERVER_MODE_ACCEPT     2       /* 建连测试, 每个连接收发 1 字节后关闭 */
+#define SEND_SERVER_MODE_UDP        3       /* UDP 回射, 统计接收方向的丢包 */
+
+#define SEND_SERVER_MAX_EVENTS      256
+#define SEND_SERVER_ACCEPT_IDLE_MS  200     /* 建连测试中监听端口空闲多久后输出统计 */
+#define SEND_SERVER_ACCEPT_RECV_TIMEOUT_S   1   /* 阻塞方式下等待客户端请求的超时 */
+#define SEND_SERVER_MAX_BATCH       1024
+#define SEND_SERVER_MAX_UDP_SIZE    65536
+#define SEND_SERVER_UDP_CTRL_SIZE   CMSG_SPACE(sizeof(uint32_t))
+#define SEND_SERVER_MAX_SENDERS     64      /* 同时跟踪序号的 UDP 发送方个数 */
 
 
 typedef int64_t         int64;
@@ -53,6 +71,18 @@ typedef uint16_t        uint16;
 
 uint16          _port = 0;
 int16           _cpu = -1;
+int32           _mode = SEND_SERVER_MODE_DRAIN;
+int64           _delayUs = 0;
+int32           _backlog = 10;
+int32           _reuseAddr = 0;
+int32           _reusePort = 0;
+int32           _fastopenQlen = 0;
+int32           _deferAcceptSec = 0;
+int32           _epollBatch = 0;
+char            *_pMcastGroup = NULL;
+char            *_pMcastIf = NULL;
+int32           _rcvbuf = 0;
+int32           _batch = 32;
 
 
 static inline int32
@@ -153,6 +183,26 @@ _SendServer_Listen(uint16 port) {
         return listenFd;
     }
 
+    if (_reuseAddr && setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR,
+            &_reuseAddr, sizeof(_reuseAddr)) < 0) {
+        fprintf(stdout, "setsockopt SO_REUSEADDR failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (_reusePort && setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT,
+            &_reusePort, sizeof(_reusePort)) < 0) {
+        fprintf(stdout, "setsockopt SO_REUSEPORT failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (_fastopenQlen > 0 && setsockopt(listenFd, IPPROTO_TCP, TCP_FASTOPEN,
+            &_fastopenQlen, sizeof(_fastopenQlen)) < 0) {
+        fprintf(stdout, "setsockopt TCP_FASTOPEN failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (_deferAcceptSec > 0 && setsockopt(listenFd, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+            &_deferAcceptSec, sizeof(_deferAcceptSec)) < 0) {
+        fprintf(stdout, "setsockopt TCP_DEFER_ACCEPT failed! %d - %s\n", errno, strerror(errno));
+    }
+
     memset(&serverAddr, 0, sizeof(serverAddr));
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_port = htons(port);
@@ -164,7 +214,7 @@ _SendServer_Listen(uint16 port) {
         return -1;
     }
 
-    if (listen(listenFd, 10) == -1) {
+    if (listen(listenFd, _backlog) == -1) {
         fprintf(stderr, "listen socket failed: %d - %s\n", errno, strerror(errno));
         close(listenFd);
         return -1;
@@ -174,6 +224,611 @@ _SendServer_Listen(uint16 port) {
 }
 
 
+/**
+ * 模拟消息处理耗时 (忙等待, 避免 usleep 的调度误差)
+ */
+static inline void
+_SendServer_Delay(int64 delayUs) {
+    int64               endNs = 0;
+
+    if (delayUs > 0) {
+        endNs = VerifyFrame_NowNs() + delayUs * 1000;
+        while (VerifyFrame_NowNs() < endNs) {
+            ;
+        }
+    }
+}
+
+
+/**
+ * 按帧接收消息, 并对每个帧回复一个应答帧 (帧头原样回传, 不含负载)
+ *
+ * @param   connfd          连接
+ * @return  大于等于0，对端正常关闭；小于0，失败
+ */
+static int32
+_SendServer_AckLoop(int32 connfd) {
+    VerifyFrameHeadT    head;
+    VerifyFrameHeadT    ack;
+    char                recvBuff[4096];
+    int32               headLen = 0;
+    int64               skipLen = 0;
+    int32               ret = 0;
+    int32               sendLen = 0;
+    int32               pos = 0;
+    int32               n = 0;
+    uint32_t            msgLen = 0;
+
+    do {
+        ret = recv(connfd, recvBuff, sizeof(recvBuff), 0);
+        if (ret == 0) {
+            fprintf(stdout, "Client Close\n");
+            return 0;
+        } else if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stdout, "Client recv failed: %d - %s\n",
+                    errno, strerror(errno));
+            return -1;
+        }
+
+        for (pos = 0; pos < ret; ) {
+            if (headLen < (int32) sizeof(head)) {
+                n = sizeof(head) - headLen;
+                if (n > ret - pos) {
+                    n = ret - pos;
+                }
+                memcpy((char *) &head + headLen, recvBuff + pos, n);
+                headLen += n;
+                pos += n;
+
+                if (headLen < (int32) sizeof(head)) {
+                    break;
+                }
+
+                msgLen = ntohl(head.msgLen);
+                if (msgLen < sizeof(head)) {
+                    fprintf(stdout, "Invalid frame length: %u\n", msgLen);
+                    return -1;
+                }
+                skipLen = msgLen - sizeof(head);
+            }
+
+            /* 负载内容不关心, 直接跳过 */
+            n = skipLen < ret - pos ? (int32) skipLen : ret - pos;
+            skipLen -= n;
+            pos += n;
+
+            if (skipLen == 0) {
+                _SendServer_Delay(_delayUs);
+
+                ack = head;
+                ack.msgLen = htonl(sizeof(ack));
+                ack.flags = htonl(ntohl(head.flags) | VERIFY_FRAME_FLAG_ACK);
+                for (n = 0; n < (int32) sizeof(ack); ) {
+                    sendLen = send(connfd, (const char *) &ack + n,
+                            sizeof(ack) - n, MSG_NOSIGNAL);
+                    if (sendLen > 0) {
+                        n += sendLen;
+                    } else if (sendLen < 0 && errno != EINTR) {
+                        /* 客户端已断开, 只关闭该连接 */
+                        fprintf(stdout, "Client send failed: %d - %s\n",
+                                errno, strerror(errno));
+                        return -1;
+                    }
+                }
+
+                headLen = 0;
+            }
+        }
+    } while (1);
+}
+
+
+/**
+ * 建连测试的统计信息
+ */
+typedef struct _SendServerAcceptStat {
+    /** 统计周期内第一个/最后一个 accept 的时间 (纳秒) */
+    int64               firstNs;
+    int64               lastNs;
+    /** 统计周期内接受的连接数 */
+    int64               accepted;
+    /** 统计周期内执行的 accept 批次数 */
+    int64               batches;
+} _SendServerAcceptStatT;
+
+
+/**
+ * 记录一批 accept 的结果
+ */
+static inline void
+_SendServer_CountAccept(_SendServerAcceptStatT *pStat, int32 count) {
+    if (count <= 0) {
+        return;
+    }
+
+    pStat->lastNs = VerifyFrame_NowNs();
+    if (pStat->accepted == 0) {
+        pStat->firstNs = pStat->lastNs;
+    }
+    pStat->accepted += count;
+    pStat->batches++;
+}
+
+
+/**
+ * 输出 accept 速率及平均批量大小
+ *
+ * 速率按统计周期内第一个到最后一个 accept 的时间计算, 不含空闲时间.
+ * 统计周期满 1 秒或者监听端口空闲 (idle) 时输出并开始新的周期.
+ *
+ * @param   pStat           统计信息
+ * @param   idle            监听端口是否空闲
+ */
+static void
+_SendServer_ReportAccept(_SendServerAcceptStatT *pStat, int32 idle) {
+    int64               spanNs = 0;
+
+    if (pStat->accepted == 0
+            || (! idle && VerifyFrame_NowNs() - pStat->firstNs < 1000000000)) {
+        return;
+    }
+
+    spanNs = pStat->lastNs - pStat->firstNs;
+    fprintf(stdout, "accept: %lld conns in %.03f ms, %.0f conn/s, avg batch %.02f\n",
+            (long long) pStat->accepted, (double) spanNs / 1000000,
+            spanNs > 0 ? (double) (pStat->accepted - 1) * 1000000000 / spanNs : 0,
+            (double) pStat->accepted / pStat->batches);
+    fflush(stdout);
+
+    pStat->accepted = 0;
+    pStat->batches = 0;
+}
+
+
+/**
+ * 读取客户端的首个请求并回复 1 字节
+ *
+ * @param   connfd          连接
+ * @param   flags           recv 的标志 (非阻塞方式下为 MSG_DONTWAIT)
+ * @return  大于0，已应答；等于0，暂无数据；小于0，连接已关闭或出错
+ */
+static int32
+_SendServer_ServeByte(int32 connfd, int32 flags) {
+    char                recvBuff[64];
+    int32               ret = 0;
+
+    do {
+        ret = recv(connfd, recvBuff, sizeof(recvBuff), flags);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret > 0) {
+        /* 客户端可能已经复位了连接, 发送失败时不退出 */
+        send(connfd, recvBuff, 1, MSG_NOSIGNAL);
+        return 1;
+    } else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+
+    return -1;
+}
+
+
+/**
+ * 建连测试 (阻塞方式): 逐个 accept, 读取请求并应答后关闭连接, 再 accept 下一个
+ *
+ * 注意: 该方式测量的是串行的 accept + 应答吞吐量 (包含每个客户端的首字节往返),
+ * 而不是单纯的 accept 速率; 需要测量 accept 速率时请使用 epoll 方式 (-E).
+ */
+static int32
+_SendServer_AcceptLoop(int32 listenFd) {
+    _SendServerAcceptStatT  stat = {0, 0, 0, 0};
+    struct timeval          idleTimeout = {0, SEND_SERVER_ACCEPT_IDLE_MS * 1000};
+    struct timeval          recvTimeout = {SEND_SERVER_ACCEPT_RECV_TIMEOUT_S, 0};
+    int32                   connfd = -1;
+
+    /* 空闲时 accept 超时返回, 以便输出最后一个统计周期 */
+    if (setsockopt(listenFd, SOL_SOCKET, SO_RCVTIMEO,
+            &idleTimeout, sizeof(idleTimeout)) < 0) {
+        fprintf(stdout, "setsockopt SO_RCVTIMEO failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    do {
+        connfd = accept(listenFd, (struct sockaddr*) NULL, NULL);
+        if (connfd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                _SendServer_ReportAccept(&stat, 1);
+                continue;
+            } else if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            fprintf(stderr, "accept failed: %d - %s\n", errno, strerror(errno));
+            return -1;
+        }
+
+        _SendServer_CountAccept(&stat, 1);
+
+        /* 避免不发送数据的客户端使服务端一直阻塞 */
+        setsockopt(connfd, SOL_SOCKET, SO_RCVTIMEO, &recvTimeout, sizeof(recvTimeout));
+        _SendServer_ServeByte(connfd, 0);
+        close(connfd);
+
+        _SendServer_ReportAccept(&stat, 0);
+    } while (1);
+}
+
+
+/**
+ * 建连测试 (epoll 方式): 监听端口可读时以 accept4 批量接受最多 _epollBatch 个连接
+ */
+static int32
+_SendServer_EpollAcceptLoop(int32 listenFd) {
+    _SendServerAcceptStatT  stat = {0, 0, 0, 0};
+    struct epoll_event      events[SEND_SERVER_MAX_EVENTS];
+    struct epoll_event      ev;
+    int32                   epollFd = -1;
+    int32                   connfd = -1;
+    int32                   count = 0;
+    int32                   fd = -1;
+    int32                   i = 0;
+    int32                   k = 0;
+
+    if (fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        fprintf(stderr, "Set NONBLOCK failed! %d - %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        fprintf(stderr, "epoll_create1 failed: %d - %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) < 0) {
+        fprintf(stderr, "epoll_ctl failed: %d - %s\n", errno, strerror(errno));
+        close(epollFd);
+        return -1;
+    }
+
+    do {
+        count = epoll_wait(epollFd, events, SEND_SERVER_MAX_EVENTS,
+                SEND_SERVER_ACCEPT_IDLE_MS);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "epoll_wait failed: %d - %s\n", errno, strerror(errno));
+            close(epollFd);
+            return -1;
+        }
+
+        for (i = 0; i < count; i++) {
+            fd = events[i].data.fd;
+
+            if (fd != listenFd) {
+                if (_SendServer_ServeByte(fd, MSG_DONTWAIT) != 0) {
+                    close(fd);
+                }
+                continue;
+            }
+
+            for (k = 0; k < _epollBatch; k++) {
+                connfd = accept4(listenFd, (struct sockaddr*) NULL, NULL,
+                        SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (connfd < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK
+                            && errno != EINTR && errno != ECONNABORTED) {
+                        fprintf(stderr, "accept4 failed: %d - %s\n",
+                                errno, strerror(errno));
+                    }
+                    break;
+                }
+
+                /* 启用 TCP_DEFER_ACCEPT/TCP_FASTOPEN 时数据通常已经到达 */
+                if (_SendServer_ServeByte(connfd, MSG_DONTWAIT) != 0) {
+                    close(connfd);
+                } else {
+                    ev.events = EPOLLIN;
+                    ev.data.fd = connfd;
+                    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, connfd, &ev) < 0) {
+                        fprintf(stderr, "epoll_ctl failed: %d - %s\n",
+                                errno, strerror(errno));
+                        close(connfd);
+                    }
+                }
+            }
+
+            _SendServer_CountAccept(&stat, k);
+        }
+
+        _SendServer_ReportAccept(&stat, count == 0);
+    } while (1);
+}
+
+
+/**
+ * UDP 发送方的序号跟踪状态
+ */
+typedef struct _SendServerUdpSender {
+    /** 发送方地址 */
+    struct sockaddr_in  addr;
+    /** 期望的下一个序号 */
+    uint64_t            expectSeq;
+    /** 最近一次收到数据的时间 (纳秒) */
+    int64               lastNs;
+} _SendServerUdpSenderT;
+
+
+/**
+ * 查找发送方的序号跟踪状态
+ *
+ * 新的发送方 (表满时替换最久未活动的一个) 或序号重新从0开始的发送方,
+ * 其期望序号同步为当前序号.
+ *
+ * @param   pSenders        发送方表 (SEND_SERVER_MAX_SENDERS 个)
+ * @param   pCount          表中已使用的个数
+ * @param   pAddr           数据报的源地址
+ * @param   seq             数据报的序号
+ * @param   nowNs           当前时间 (纳秒)
+ * @return  发送方的序号跟踪状态
+ */
+static _SendServerUdpSenderT *
+_SendServer_LookupSender(_SendServerUdpSenderT *pSenders, int32 *pCount,
+        const struct sockaddr_in *pAddr, uint64_t seq, int64 nowNs) {
+    _SendServerUdpSenderT   *pSender = NULL;
+    int32                   i = 0;
+
+    for (i = 0; i < *pCount; i++) {
+        if (pSenders[i].addr.sin_addr.s_addr == pAddr->sin_addr.s_addr
+                && pSenders[i].addr.sin_port == pAddr->sin_port) {
+            pSender = &pSenders[i];
+            break;
+        }
+    }
+
+    if (pSender == NULL) {
+        if (*pCount < SEND_SERVER_MAX_SENDERS) {
+            pSender = &pSenders[(*pCount)++];
+        } else {
+            pSender = &pSenders[0];
+            for (i = 1; i < *pCount; i++) {
+                if (pSenders[i].lastNs < pSender->lastNs) {
+                    pSender = &pSenders[i];
+                }
+            }
+        }
+
+        pSender->addr = *pAddr;
+        pSender->expectSeq = seq;
+    } else if (seq == 0) {
+        pSender->expectSeq = seq;
+    }
+
+    pSender->lastNs = nowNs;
+    return pSender;
+}
+
+
+/**
+ * UDP 回射服务: 以 recvmmsg 批量接收, 对每个数据报以 sendmmsg 批量回送帧头,
+ * 并按发送方 (地址:端口) 分别跟踪序号, 统计接收方向的丢包和乱序
+ */
+static int32
+_SendServer_UdpMain(void) {
+    struct sockaddr_in  serverAddr;
+    struct ip_mreqn     mreq;
+    struct timeval      timeout = {1, 0};
+    struct mmsghdr      *pMsgs = NULL;
+    struct mmsghdr      *pAckMsgs = NULL;
+    struct iovec        *pIovs = NULL;
+    struct iovec        *pAckIovs = NULL;
+    struct sockaddr_in  *pAddrs = NULL;
+    VerifyFrameHeadT    *pAcks = NULL;
+    char                *pBuffs = NULL;
+    char                *pControls = NULL;
+    struct cmsghdr      *pCmsg = NULL;
+    _SendServerUdpSenderT   senders[SEND_SERVER_MAX_SENDERS];
+    _SendServerUdpSenderT   *pSender = NULL;
+    int32               senderCount = 0;
+    uint64_t            seq = 0;
+    uint32_t            ovfl = 0;
+    uint32_t            lastOvfl = 0;
+    int64               lastReportNs = VerifyFrame_NowNs();
+    int64               nowNs = 0;
+    int64               received = 0;
+    int64               gaps = 0;
+    int64               reordered = 0;
+    int64               rxqDrops = 0;
+    int32               socketFd = -1;
+    int32               iOptVal = 1;
+    int32               count = 0;
+    int32               acks = 0;
+    int32               ret = -1;
+    int32               i = 0;
+
+    socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0) {
+        fprintf(stderr, "Create socket failed: %d - %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    if (_reuseAddr && setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR,
+            &_reuseAddr, sizeof(_reuseAddr)) < 0) {
+        fprintf(stdout, "setsockopt SO_REUSEADDR failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    if (_rcvbuf > 0) {
+        if (setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &_rcvbuf, sizeof(_rcvbuf)) < 0) {
+            fprintf(stdout, "setsockopt SO_RCVBUF failed! %d - %s\n", errno, strerror(errno));
+        }
+    }
+
+    if (setsockopt(socketFd, SOL_SOCKET, SO_RXQ_OVFL, &iOptVal, sizeof(iOptVal)) < 0) {
+        fprintf(stdout, "setsockopt SO_RXQ_OVFL failed! %d - %s\n", errno, strerror(errno));
+    }
+
+    /* 空闲时也定期输出统计 */
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(_port);
+    serverAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(socketFd, (struct sockaddr*) &serverAddr, sizeof(serverAddr)) < 0){
+        fprintf(stderr, "Bind failed: %d - %s\n", errno, strerror(errno));
+        goto ON_END;
+    }
+
+    if (_pMcastGroup) {
+        memset(&mreq, 0, sizeof(mreq));
+        if (inet_pton(AF_INET, _pMcastGroup, &mreq.imr_multiaddr) <= 0
+                || (_pMcastIf && inet_pton(AF_INET, _pMcastIf, &mreq.imr_address) <= 0)) {
+            fprintf(stderr, "inet_pton error for %s/%s\n", _pMcastGroup,
+                    _pMcastIf ? _pMcastIf : "*");
+            goto ON_END;
+        }
+
+        if (setsockopt(socketFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            fprintf(stderr, "Join multicast group failed: %d - %s\n", errno, strerror(errno));
+            goto ON_END;
+        }
+        fprintf(stdout, "Joined multicast group %s\n", _pMcastGroup);
+        fflush(stdout);
+    }
+
+    pMsgs = calloc(_batch, sizeof(struct mmsghdr));
+    pAckMsgs = calloc(_batch, sizeof(struct mmsghdr));
+    pIovs = calloc(_batch, sizeof(struct iovec));
+    pAckIovs = calloc(_batch, sizeof(struct iovec));
+    pAddrs = calloc(_batch, sizeof(struct sockaddr_in));
+    pAcks = calloc(_batch, sizeof(VerifyFrameHeadT));
+    pBuffs = malloc(_batch * SEND_SERVER_MAX_UDP_SIZE);
+    pControls = calloc(_batch, SEND_SERVER_UDP_CTRL_SIZE);
+    if (pMsgs == NULL || pAckMsgs == NULL || pIovs == NULL || pAckIovs == NULL
+            || pAddrs == NULL || pAcks == NULL || pBuffs == NULL
+            || pControls == NULL) {
+        fprintf(stderr, "malloc failed: %d - %s\n", errno, strerror(errno));
+        goto ON_END;
+    }
+
+    for (i = 0; i < _batch; i++) {
+        pIovs[i].iov_base = pBuffs + i * SEND_SERVER_MAX_UDP_SIZE;
+        pIovs[i].iov_len = SEND_SERVER_MAX_UDP_SIZE;
+        pMsgs[i].msg_hdr.msg_iov = &pIovs[i];
+        pMsgs[i].msg_hdr.msg_iovlen = 1;
+        pMsgs[i].msg_hdr.msg_name = &pAddrs[i];
+        pMsgs[i].msg_hdr.msg_control = pControls + i * SEND_SERVER_UDP_CTRL_SIZE;
+
+        pAckIovs[i].iov_base = &pAcks[i];
+        pAckIovs[i].iov_len = sizeof(VerifyFrameHeadT);
+        pAckMsgs[i].msg_hdr.msg_iov = &pAckIovs[i];
+        pAckMsgs[i].msg_hdr.msg_iovlen = 1;
+        pAckMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+
+    if (_cpu >= 0) {
+        _SendServer_SetCpuAffinity(_cpu);
+    }
+
+    do {
+        for (i = 0; i < _batch; i++) {
+            pMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            pMsgs[i].msg_hdr.msg_controllen = SEND_SERVER_UDP_CTRL_SIZE;
+        }
+
+        count = recvmmsg(socketFd, pMsgs, _batch, MSG_WAITFORONE, NULL);
+        if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            fprintf(stderr, "recvmmsg failed: %d - %s\n", errno, strerror(errno));
+            goto ON_END;
+        }
+
+        nowNs = VerifyFrame_NowNs();
+        for (i = 0, acks = 0; i < count; i++) {
+            for (pCmsg = CMSG_FIRSTHDR(&pMsgs[i].msg_hdr); pCmsg;
+                    pCmsg = CMSG_NXTHDR(&pMsgs[i].msg_hdr, pCmsg)) {
+                if (pCmsg->cmsg_level == SOL_SOCKET
+                        && pCmsg->cmsg_type == SO_RXQ_OVFL) {
+                    memcpy(&ovfl, CMSG_DATA(pCmsg), sizeof(ovfl));
+                    rxqDrops += (uint32_t) (ovfl - lastOvfl);
+                    lastOvfl = ovfl;
+                }
+            }
+
+            if (pMsgs[i].msg_len < sizeof(VerifyFrameHeadT)) {
+                continue;
+            }
+
+            received++;
+            memcpy(&pAcks[acks], pIovs[i].iov_base, sizeof(VerifyFrameHeadT));
+            seq = be64toh(pAcks[acks].seq);
+
+            pSender = _SendServer_LookupSender(senders, &senderCount,
+                    &pAddrs[i], seq, nowNs);
+            if (seq > pSender->expectSeq) {
+                gaps += seq - pSender->expectSeq;
+            } else if (seq < pSender->expectSeq) {
+                reordered++;
+            }
+            if (seq >= pSender->expectSeq) {
+                pSender->expectSeq = seq + 1;
+            }
+
+            pAcks[acks].msgLen = htonl(sizeof(VerifyFrameHeadT));
+            pAcks[acks].flags = htonl(ntohl(pAcks[acks].flags) | VERIFY_FRAME_FLAG_ACK);
+            pAckMsgs[acks].msg_hdr.msg_name = &pAddrs[i];
+            acks++;
+        }
+
+        for (i = 0; i < acks; ) {
+            ret = sendmmsg(socketFd, pAckMsgs + i, acks - i, 0);
+            if (ret > 0) {
+                i += ret;
+            } else if (errno != EINTR) {
+                /* 回送失败时丢弃, 由客户端计入丢包 */
+                fprintf(stderr, "sendmmsg failed: %d - %s\n", errno, strerror(errno));
+                break;
+            }
+        }
+
+        nowNs = VerifyFrame_NowNs();
+        if (nowNs - lastReportNs >= 1000000000) {
+            if (received > 0 || rxqDrops > 0) {
+                fprintf(stdout, "udp: %.0f msg/s, gaps %lld, reordered %lld, "
+                        "rxq drops %lld\n",
+                        (double) received * 1000000000 / (nowNs - lastReportNs),
+                        (long long) gaps, (long long) reordered,
+                        (long long) rxqDrops);
+                fflush(stdout);
+            }
+
+            lastReportNs = nowNs;
+            received = 0;
+            gaps = 0;
+            reordered = 0;
+            rxqDrops = 0;
+        }
+    } while (1);
+
+ON_END:
+    free(pMsgs);
+    free(pAckMsgs);
+    free(pIovs);
+    free(pAckIovs);
+    free(pAddrs);
+    free(pAcks);
+    free(pBuffs);
+    free(pControls);
+    close(socketFd);
+    return -1;
+}
+
+
 /**
  * API接口库示例程序的主函数
  */
@@ -183,6 +838,11 @@ _SendServer_Main(void) {
     int32               connfd = -1;
     int32               ret = 0;
     char                recvBuff[4096] = {0};
+    int32               iOptVal = 0;
+
+    if (_mode == SEND_SERVER_MODE_UDP) {
+        return _SendServer_UdpMain();
+    }
 
     listenFd = _SendServer_Listen(_port);
     if (listenFd < 0) {
@@ -194,6 +854,15 @@ _SendServer_Main(void) {
     }
 
 
+    if (_mode == SEND_SERVER_MODE_ACCEPT) {
+        if (_epollBatch > 0) {
+            _SendServer_EpollAcceptLoop(listenFd);
+        } else {
+            _SendServer_AcceptLoop(listenFd);
+        }
+        goto ON_ERROR;
+    }
+
     do {
         connfd = accept(listenFd, (struct sockaddr*) NULL, NULL);
         if (connfd < 0) {
@@ -203,6 +872,20 @@ _SendServer_Main(void) {
 
         fprintf(stdout, "New Connection\n");
 
+        if (_mode == SEND_SERVER_MODE_ACK) {
+            /* 应答帧很小, 关闭 Nagle 以免被延迟发送 */
+            iOptVal = 1;
+            if (setsockopt(connfd, IPPROTO_TCP, TCP_NODELAY,
+                    &iOptVal, sizeof(iOptVal)) < 0) {
+                fprintf(stdout, "setsockopt TCP_NODELAY failed! %d - %s\n",
+                        errno, strerror(errno));
+            }
+
+            _SendServer_AckLoop(connfd);
+            close(connfd);
+            continue;
+        }
+
         do {
             ret = recv(connfd, recvBuff, sizeof(recvBuff), 0);
             if (ret == 0 ) {
@@ -238,10 +921,22 @@ ON_ERROR:
 
 int
 main(int argc, char *argv[]) {
-    static const char       short_options[] = "p:c:";
+    static const char       short_options[] = "p:c:M:D:l:a:u:f:e:E:g:I:R:B:";
     static struct option    long_options[] = {
         { "port",               1,  NULL,   'p' },
         { "cpu",                1,  NULL,   'c' },
+        { "mode",               1,  NULL,   'M' },
+        { "delay",              1,  NULL,   'D' },
+        { "backlog",            1,  NULL,   'l' },
+        { "reuseaddr",          1,  NULL,   'a' },
+        { "reuseport",          1,  NULL,   'u' },
+        { "fastopen",           1,  NULL,   'f' },
+        { "defer-accept",       1,  NULL,   'e' },
+        { "epoll-batch",        1,  NULL,   'E' },
+        { "mcast-group",        1,  NULL,   'g' },
+        { "mcast-if",           1,  NULL,   'I' },
+        { "rcv-buf",            1,  NULL,   'R' },
+        { "batch",              1,  NULL,   'B' },
         { 0, 0, 0, 0 }
     };
 
@@ -279,6 +974,153 @@ main(int argc, char *argv[]) {
             }
             break;
 
+        case 'M':
+            if (optarg) {
+                if (strcmp(optarg, "drain") == 0) {
+                    _mode = SEND_SERVER_MODE_DRAIN;
+                } else if (strcmp(optarg, "ack") == 0) {
+                    _mode = SEND_SERVER_MODE_ACK;
+                } else if (strcmp(optarg, "accept") == 0) {
+                    _mode = SEND_SERVER_MODE_ACCEPT;
+                } else if (strcmp(optarg, "udp") == 0) {
+                    _mode = SEND_SERVER_MODE_UDP;
+                } else {
+                    fprintf(stderr, "ERROR: Invalid mode value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid mode params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'D':
+            if (optarg) {
+                _delayUs = strtol(optarg, NULL, 10);
+                if (_delayUs < 0 || _delayUs > 100000000) {
+                    fprintf(stderr, "ERROR: Invalid delay value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid delay params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'l':
+            if (optarg) {
+                _backlog = strtol(optarg, NULL, 10);
+                if (_backlog < 1) {
+                    fprintf(stderr, "ERROR: Invalid backlog value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid backlog params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'a':
+            if (optarg) {
+                _reuseAddr = strtol(optarg, NULL, 10);
+            } else {
+                fprintf(stderr, "ERROR: Invalid reuseaddr params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'u':
+            if (optarg) {
+                _reusePort = strtol(optarg, NULL, 10);
+            } else {
+                fprintf(stderr, "ERROR: Invalid reuseport params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'f':
+            if (optarg) {
+                _fastopenQlen = strtol(optarg, NULL, 10);
+                if (_fastopenQlen < 0) {
+                    fprintf(stderr, "ERROR: Invalid fastopen value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid fastopen params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'e':
+            if (optarg) {
+                _deferAcceptSec = strtol(optarg, NULL, 10);
+                if (_deferAcceptSec < 0) {
+                    fprintf(stderr, "ERROR: Invalid defer-accept value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid defer-accept params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'E':
+            if (optarg) {
+                _epollBatch = strtol(optarg, NULL, 10);
+                if (_epollBatch < 0) {
+                    fprintf(stderr, "ERROR: Invalid epoll-batch value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid epoll-batch params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'g':
+            if (optarg && strlen(optarg) > 0) {
+                _pMcastGroup = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid mcast-group params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'I':
+            if (optarg && strlen(optarg) > 0) {
+                _pMcastIf = optarg;
+            } else {
+                fprintf(stderr, "ERROR: Invalid mcast-if params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'R':
+            if (optarg) {
+                _rcvbuf = strtol(optarg, NULL, 10);
+                if (_rcvbuf <= 0) {
+                    fprintf(stderr, "ERROR: Invalid rcv-buf value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid rcv-buf params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
+        case 'B':
+            if (optarg) {
+                _batch = strtol(optarg, NULL, 10);
+                if (_batch < 1 || _batch > SEND_SERVER_MAX_BATCH) {
+                    fprintf(stderr, "ERROR: Invalid batch value!\n\n");
+                    return -EINVAL;
+                }
+            } else {
+                fprintf(stderr, "ERROR: Invalid batch params!\n\n");
+                return -EINVAL;
+            }
+            break;
+
         default:
             fprintf(stderr, "ERROR: Invalid options! ('%c')\n\n", c);
             return -EINVAL;